@@ -2,7 +2,7 @@
   "targets": [
     {
       "target_name": "pmemkv",
-      "sources": ["lib/database.cc", "lib/pmemkv.cc"],
+      "sources": ["lib/change_feed.cc", "lib/compression.cc", "lib/database.cc", "lib/pmemkv.cc", "lib/value_writer.cc"],
       "include_dirs": [
           "<!@(node -p \"require('node-addon-api').include\")"
       ],
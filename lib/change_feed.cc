@@ -0,0 +1,84 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "change_feed.h"
+
+change_feed::change_feed() : _subscriptions(), _next_id(0) {
+}
+
+uint32_t change_feed::subscribe(ChangeFilter filter, pmem::kv::string_view lower, pmem::kv::string_view upper, bool has_upper) {
+    subscription sub;
+    sub.filter = filter;
+    sub.lower.assign(lower.data(), lower.size());
+    sub.upper.assign(upper.data(), upper.size());
+    sub.has_upper = has_upper;
+    uint32_t id = this->_next_id++;
+    this->_subscriptions.emplace(id, std::move(sub));
+    return id;
+}
+
+void change_feed::unsubscribe(uint32_t id) {
+    this->_subscriptions.erase(id);
+}
+
+void change_feed::record(pmem::kv::string_view key, bool removed) {
+    if (this->_subscriptions.empty()){
+        return;
+    }
+    std::string key_str(key.data(), key.size());
+    for (auto& it : this->_subscriptions){
+        if (it.second.matches(key_str)){
+            it.second.changes[key_str] = removed;
+        }
+    }
+}
+
+/*
+ * Moves pending changes of subscription *id* to *changes*.
+ * Returns false if there is no such subscription.
+ */
+bool change_feed::take(uint32_t id, std::map<std::string, bool>& changes) {
+    auto it = this->_subscriptions.find(id);
+    if (it == this->_subscriptions.end()){
+        return false;
+    }
+    changes.clear();
+    changes.swap(it->second.changes);
+    return true;
+}
+
+bool change_feed::subscription::matches(const std::string& key) const {
+    if (filter == CHANGE_FILTER_PREFIX){
+        return key.compare(0, lower.size(), lower) == 0;
+    }
+    return key.compare(lower) >= 0 && (!has_upper || key.compare(upper) < 0);
+}
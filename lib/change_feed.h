@@ -0,0 +1,72 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CHANGE_FEED_H
+#define CHANGE_FEED_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <libpmemkv.hpp>
+
+enum ChangeFilter {CHANGE_FILTER_PREFIX, CHANGE_FILTER_RANGE};
+
+/*
+ * Log of keys modified through a db instance, kept per subscription.
+ * Changes are coalesced by key until taken, so a batch holds only the last
+ * operation (put or remove) for every key matching the subscription's filter.
+ */
+class change_feed {
+  public:
+    change_feed();
+
+    uint32_t subscribe(ChangeFilter filter, pmem::kv::string_view lower, pmem::kv::string_view upper, bool has_upper);
+    void unsubscribe(uint32_t id);
+    void record(pmem::kv::string_view key, bool removed);
+    bool take(uint32_t id, std::map<std::string, bool>& changes);
+
+  private:
+    struct subscription {
+        ChangeFilter filter;
+        std::string lower;
+        std::string upper;
+        bool has_upper;
+        std::map<std::string, bool> changes;
+
+        bool matches(const std::string& key) const;
+    };
+
+    std::map<uint32_t, subscription> _subscriptions;
+    uint32_t _next_id;
+};
+
+#endif
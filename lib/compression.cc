@@ -0,0 +1,240 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "compression.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <zlib.h>
+
+/*
+ * Every stored value starts with this magic and the format version, so that
+ * values written with compression disabled, or by an incompatible version,
+ * are reported instead of being misread. 0xff never starts a UTF-8 string.
+ */
+static const char MAGIC[] = {'\xff', 'P', 'K', 'V'};
+static const char FORMAT_VERSION = 1;
+/* Magic, version and tag, followed by the raw value or by a compressed one. */
+static const std::size_t PREFIX_SIZE = sizeof(MAGIC) + 2;
+/* Compressed values are split into independently deflated blocks of this size. */
+static const std::size_t BLOCK_SIZE = 64 * 1024;
+/* Prefix and original length, followed by the end offset of every block's frame. */
+static const std::size_t HEADER_SIZE = PREFIX_SIZE + sizeof(uint64_t);
+static const std::size_t OFFSET_SIZE = sizeof(uint64_t);
+
+/*
+ * Lengths and offsets are stored little-endian regardless of the host,
+ * so that a pool stays readable on machines with a different byte order.
+ */
+static void store_size(char* out, uint64_t size) {
+    for (std::size_t i = 0; i < sizeof(size); ++i){
+        out[i] = static_cast<char>((size >> (8 * i)) & 0xff);
+    }
+}
+
+static uint64_t load_size(const char* in) {
+    uint64_t size = 0;
+    for (std::size_t i = 0; i < sizeof(size); ++i){
+        size |= uint64_t(static_cast<unsigned char>(in[i])) << (8 * i);
+    }
+    return size;
+}
+
+compression::compression() : _codec(COMPRESSION_NONE), _min_size(0), _raw_bytes(0), _stored_bytes(0) {
+}
+
+pmem::kv::status compression::configure(const std::string& codec, std::size_t min_size) {
+    if (codec.compare("zlib") == 0){
+        this->_codec = COMPRESSION_ZLIB;
+    }
+    else if (codec.compare("lz4") == 0 || codec.compare("zstd") == 0){
+        return pmem::kv::status::NOT_SUPPORTED;
+    }
+    else {
+        return pmem::kv::status::INVALID_ARGUMENT;
+    }
+    this->_min_size = min_size;
+    return pmem::kv::status::OK;
+}
+
+bool compression::enabled() const {
+    return this->_codec != COMPRESSION_NONE;
+}
+
+const char* compression::codec_name() const {
+    return this->_codec == COMPRESSION_ZLIB ? "zlib" : "none";
+}
+
+/*
+ * Compressed values are stored as a table of frame end offsets followed by
+ * one frame per BLOCK_SIZE bytes of the value. A frame as long as its block
+ * holds the block raw, any shorter one is the block deflated on its own, so
+ * a range of the value can be decoded without touching other blocks.
+ */
+pmem::kv::string_view compression::encode(pmem::kv::string_view value, std::string& buf) {
+    if (!enabled()){
+        return value;
+    }
+    bool compressed = false;
+    if (value.size() >= this->_min_size){
+        std::size_t blocks = (value.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        std::size_t table_end = HEADER_SIZE + blocks * OFFSET_SIZE;
+        buf.assign(table_end, '\0');
+        std::memcpy(&buf[0], MAGIC, sizeof(MAGIC));
+        buf[PREFIX_SIZE - 2] = FORMAT_VERSION;
+        buf[PREFIX_SIZE - 1] = TAG_ZLIB;
+        store_size(&buf[PREFIX_SIZE], value.size());
+        std::string frame(compressBound(BLOCK_SIZE), '\0');
+        for (std::size_t i = 0; i < blocks && buf.size() < PREFIX_SIZE + value.size(); ++i){
+            const char* block = value.data() + i * BLOCK_SIZE;
+            std::size_t block_size = std::min(BLOCK_SIZE, value.size() - i * BLOCK_SIZE);
+            uLongf length = frame.size();
+            int ret = compress2(reinterpret_cast<Bytef*>(&frame[0]), &length,
+                reinterpret_cast<const Bytef*>(block), block_size, Z_DEFAULT_COMPRESSION);
+            if (ret == Z_OK && length < block_size){
+                buf.append(frame.data(), length);
+            }
+            else {
+                buf.append(block, block_size);
+            }
+            store_size(&buf[HEADER_SIZE + i * OFFSET_SIZE], buf.size() - table_end);
+        }
+        compressed = (buf.size() < PREFIX_SIZE + value.size());
+    }
+    if (!compressed){
+        buf.assign(MAGIC, sizeof(MAGIC));
+        buf.push_back(FORMAT_VERSION);
+        buf.push_back(TAG_RAW);
+        buf.append(value.data(), value.size());
+    }
+    return pmem::kv::string_view(buf.data(), buf.size());
+}
+
+DecodeStatus compression::decode(pmem::kv::string_view stored, std::string& buf, pmem::kv::string_view& value) const {
+    return decode_range(stored, 0, SIZE_MAX, buf, value);
+}
+
+/*
+ * Decodes bytes [start, end) of the value, clamped to its size. Raw values
+ * are returned as views into *stored* without copying. For compressed ones
+ * only the blocks overlapping the range are inflated, so memory and work are
+ * bounded by the range, not by the whole value.
+ */
+DecodeStatus compression::decode_range(pmem::kv::string_view stored, std::size_t start, std::size_t end,
+        std::string& buf, pmem::kv::string_view& value) const {
+    pmem::kv::string_view raw = stored;
+    if (enabled()){
+        if (stored.size() < PREFIX_SIZE || std::memcmp(stored.data(), MAGIC, sizeof(MAGIC)) != 0){
+            return DECODE_FOREIGN;
+        }
+        if (stored.data()[PREFIX_SIZE - 2] != FORMAT_VERSION){
+            return DECODE_UNSUPPORTED;
+        }
+        raw = pmem::kv::string_view(stored.data() + PREFIX_SIZE, stored.size() - PREFIX_SIZE);
+    }
+    if (!enabled() || stored.data()[PREFIX_SIZE - 1] == TAG_RAW){
+        std::size_t from = std::min(start, raw.size());
+        std::size_t to = std::min(std::max(end, from), raw.size());
+        value = pmem::kv::string_view(raw.data() + from, to - from);
+        return DECODE_OK;
+    }
+    if (stored.data()[PREFIX_SIZE - 1] != TAG_ZLIB){
+        return DECODE_UNSUPPORTED;
+    }
+    if (stored.size() < HEADER_SIZE){
+        return DECODE_CORRUPTED;
+    }
+    uint64_t raw_size = load_size(stored.data() + PREFIX_SIZE);
+    uint64_t blocks = raw_size / BLOCK_SIZE + (raw_size % BLOCK_SIZE != 0);
+    if (blocks > (stored.size() - HEADER_SIZE) / OFFSET_SIZE){
+        return DECODE_CORRUPTED;
+    }
+    const char* table = stored.data() + HEADER_SIZE;
+    const char* frames = table + blocks * OFFSET_SIZE;
+    std::size_t frames_size = stored.size() - HEADER_SIZE - blocks * OFFSET_SIZE;
+
+    std::size_t from = std::min<uint64_t>(start, raw_size);
+    std::size_t to = std::min<uint64_t>(std::max(end, from), raw_size);
+    buf.resize(to - from);
+    value = pmem::kv::string_view(buf.data(), buf.size());
+    std::string scratch;
+    for (std::size_t i = from / BLOCK_SIZE; from < to && i <= (to - 1) / BLOCK_SIZE; ++i){
+        uint64_t frame_begin = (i == 0) ? 0 : load_size(table + (i - 1) * OFFSET_SIZE);
+        uint64_t frame_end = load_size(table + i * OFFSET_SIZE);
+        if (frame_begin > frame_end || frame_end > frames_size){
+            return DECODE_CORRUPTED;
+        }
+        std::size_t block_begin = i * BLOCK_SIZE;
+        std::size_t block_size = std::min<uint64_t>(BLOCK_SIZE, raw_size - block_begin);
+        std::size_t lo = std::max(from, block_begin);
+        std::size_t hi = std::min(to, block_begin + block_size);
+        const char* frame = frames + frame_begin;
+        std::size_t frame_size = frame_end - frame_begin;
+        if (frame_size == block_size){
+            std::memcpy(&buf[lo - from], frame + (lo - block_begin), hi - lo);
+            continue;
+        }
+        bool whole = (lo == block_begin && hi == block_begin + block_size);
+        if (!whole){
+            scratch.resize(block_size);
+        }
+        char* out = whole ? &buf[lo - from] : &scratch[0];
+        uLongf length = block_size;
+        int ret = uncompress(reinterpret_cast<Bytef*>(out), &length,
+            reinterpret_cast<const Bytef*>(frame), frame_size);
+        if (ret != Z_OK || length != block_size){
+            return DECODE_CORRUPTED;
+        }
+        if (!whole){
+            std::memcpy(&buf[lo - from], scratch.data() + (lo - block_begin), hi - lo);
+        }
+    }
+    return DECODE_OK;
+}
+
+/*
+ * Adds a successfully stored value to the write statistics.
+ */
+void compression::account(std::size_t raw_size, std::size_t stored_size) {
+    if (enabled()){
+        this->_raw_bytes += raw_size;
+        this->_stored_bytes += stored_size;
+    }
+}
+
+std::size_t compression::raw_bytes() const {
+    return this->_raw_bytes;
+}
+
+std::size_t compression::stored_bytes() const {
+    return this->_stored_bytes;
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <string>
+#include <libpmemkv.hpp>
+
+enum CompressionCodec {COMPRESSION_NONE, COMPRESSION_ZLIB};
+enum StoredTag : char {TAG_RAW = 0, TAG_ZLIB = 1};
+enum DecodeStatus {DECODE_OK, DECODE_FOREIGN, DECODE_UNSUPPORTED, DECODE_CORRUPTED};
+
+/*
+ * Transparent value compression, configured per database.
+ *
+ * When enabled, every stored value starts with a magic, a format version and
+ * a one-byte tag: values shorter than min_size, or which do not shrink, are
+ * stored raw after the tag; others
+ * are followed by their original length (64-bit little-endian) and the value
+ * deflated in independent fixed-size blocks, so that any range of it can be
+ * decoded in memory and time bounded by the range.
+ * Reading a value without the magic, e.g. after reopening a database created
+ * without compression, fails with DECODE_FOREIGN. The opposite mismatch cannot
+ * be detected, since values are then stored verbatim: a database with
+ * compression enabled must always be reopened with it.
+ */
+class compression {
+  public:
+    compression();
+
+    pmem::kv::status configure(const std::string& codec, std::size_t min_size);
+    bool enabled() const;
+    const char* codec_name() const;
+
+    pmem::kv::string_view encode(pmem::kv::string_view value, std::string& buf);
+    DecodeStatus decode(pmem::kv::string_view stored, std::string& buf, pmem::kv::string_view& value) const;
+    DecodeStatus decode_range(pmem::kv::string_view stored, std::size_t start, std::size_t end,
+        std::string& buf, pmem::kv::string_view& value) const;
+
+    void account(std::size_t raw_size, std::size_t stored_size);
+    std::size_t raw_bytes() const;
+    std::size_t stored_bytes() const;
+
+  private:
+    CompressionCodec _codec;
+    std::size_t _min_size;
+    std::size_t _raw_bytes;
+    std::size_t _stored_bytes;
+};
+
+#endif
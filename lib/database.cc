@@ -31,7 +31,12 @@
  */
 
 #include "database.h"
+#include "value_writer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <string>
+#include <vector>
 
 #define GET_STRING_VIEW(env, input, output, output_str) \
     do{\
@@ -49,12 +54,119 @@
         }\
     } while(0)
 
+#define DECODE_VALUE(value, value_str, decoded) \
+    do{\
+        decoded = this->_compression.decode(value, value_str, value);\
+        if (decoded != DECODE_OK){\
+            return 1;\
+        }\
+    } while(0)
+
+#define THROW_IF_NOT_DECODED(env, decoded) \
+    do{\
+        if (decoded != DECODE_OK){\
+            Napi::Error e = Napi::Error::New(env, decode_errormsg(decoded));\
+            e.Set("status", Napi::Number::New(env, int(decoded == DECODE_UNSUPPORTED ?\
+                pmem::kv::status::NOT_SUPPORTED : pmem::kv::status::UNKNOWN_ERROR)));\
+            e.ThrowAsJavaScriptException();\
+            return env.Undefined();\
+        }\
+    } while(0)
+
+/* Largest integer a JS number holds exactly (Number.MAX_SAFE_INTEGER). */
+static const double MAX_SAFE_INTEGER = 9007199254740991.0;
+
+const char* decode_errormsg(DecodeStatus decoded) {
+    switch (decoded){
+        case DECODE_FOREIGN:
+            return "stored value was not written with compression enabled";
+        case DECODE_UNSUPPORTED:
+            return "stored value has an unsupported compression format";
+        default:
+            return "cannot decompress stored value";
+    }
+}
+
 Napi::String create_napi_string(Napi::Env env, pmem::kv::string_view view){ 
     return Napi::String::New(env, view.data(), view.size());
 }
 
-Napi::Buffer<char> create_napi_buffer(Napi::Env env, pmem::kv::string_view view){
-    return Napi::Buffer<char>::New(env, const_cast<char*>(view.data()), view.size());
+/*
+ * Copies keys and values returned to JS, so that writes to the Buffers cannot
+ * reach pmem. Small records share chunks allocated per scan and are handed
+ * out as subarrays of them, instead of allocating a backing store per record.
+ */
+class record_copier {
+  public:
+    record_copier(Napi::Env env) : _env(env), _used(CHUNK_SIZE) {}
+    record_copier(const record_copier&) = delete;
+    record_copier& operator=(const record_copier&) = delete;
+
+    Napi::Buffer<char> copy(pmem::kv::string_view data);
+
+  private:
+    static const std::size_t CHUNK_SIZE = 8 * 1024;
+    static const std::size_t MAX_SHARED_SIZE = CHUNK_SIZE / 8;
+
+    Napi::Env _env;
+    Napi::Buffer<char> _chunk;
+    Napi::Function _subarray;
+    std::size_t _used;
+};
+
+Napi::Buffer<char> record_copier::copy(pmem::kv::string_view data) {
+    if (data.size() > MAX_SHARED_SIZE){
+        return Napi::Buffer<char>::Copy(_env, data.data(), data.size());
+    }
+    if (_chunk.IsEmpty() || CHUNK_SIZE - _used < data.size()){
+        _chunk = Napi::Buffer<char>::New(_env, CHUNK_SIZE);
+        _subarray = _chunk.Get("subarray").As<Napi::Function>();
+        _used = 0;
+    }
+    std::memcpy(_chunk.Data() + _used, data.data(), data.size());
+    Napi::Value slice = _subarray.Call(_chunk, {Napi::Number::New(_env, _used), Napi::Number::New(_env, _used + data.size())});
+    _used += data.size();
+    return slice.As<Napi::Buffer<char>>();
+}
+
+/*
+ * Buffers over native memory which is valid only inside the engine's callback,
+ * wrapped without copying it to the V8 heap. Views are detached when the lease
+ * goes out of scope, so a Buffer kept past the callback is empty instead of
+ * pointing at freed memory. Without detach support they are copies.
+ * The memory must be private to the caller, never pmem owned by pmemkv,
+ * since JS can write to the Buffer.
+ */
+class read_lease {
+  public:
+    read_lease(Napi::Env env) : _env(env) {}
+    ~read_lease();
+    read_lease(const read_lease&) = delete;
+    read_lease& operator=(const read_lease&) = delete;
+
+    Napi::Buffer<char> view(std::string& data);
+
+  private:
+    Napi::Env _env;
+    std::vector<Napi::Buffer<char>> _views;
+};
+
+read_lease::~read_lease() {
+#if NAPI_VERSION > 6
+    for (auto& view : _views){
+        view.ArrayBuffer().Detach();
+    }
+#endif
+}
+
+Napi::Buffer<char> read_lease::view(std::string& data) {
+#if NAPI_VERSION > 6
+    Napi::Buffer<char> buffer = Napi::Buffer<char>::New(_env, &data[0], data.size());
+    _views.push_back(buffer);
+    return buffer;
+#else
+    return Napi::Buffer<char>::Copy(_env, data.data(), data.size());
+#endif
 }
 
 Napi::FunctionReference db::constructor;
@@ -83,8 +195,15 @@ Napi::Object db::init(Napi::Env env, Napi::Object exports) {
             InstanceMethod("exists", &db::exists),
             InstanceMethod("get", &db::get),
             InstanceMethod("get_as_buffer", &db::get_as_buffer),
+            InstanceMethod("get_range", &db::get_range),
+            InstanceMethod("with_view", &db::with_view),
             InstanceMethod("put", &db::put),
-            InstanceMethod("remove", &db::remove)
+            InstanceMethod("put_staged", &db::put_staged),
+            InstanceMethod("remove", &db::remove),
+            InstanceMethod("compression_stats", &db::compression_stats),
+            InstanceMethod("subscribe", &db::subscribe),
+            InstanceMethod("unsubscribe", &db::unsubscribe),
+            InstanceMethod("take_changes", &db::take_changes)
     });
     constructor = Napi::Persistent(func);
     constructor.SuppressDestruct();
@@ -140,7 +259,35 @@ db::db(const Napi::CallbackInfo& info) : Napi::ObjectWrap<db>(info), _db() {
             return;
         }
         Napi::Value value = config.Get(key);
-        if (value.IsString()){
+        if (key.As<Napi::String>().Utf8Value().compare("compression") == 0){
+            if (!value.IsObject()){
+                Napi::Error e = Napi::Error::New(env, "compression should be an object");
+                e.Set("status", Napi::Number::New(env, int(pmem::kv::status::INVALID_ARGUMENT)));
+                e.ThrowAsJavaScriptException();
+                return;
+            }
+            Napi::Object compression_obj = value.As<Napi::Object>();
+            Napi::Value codec = compression_obj.Get("codec");
+            Napi::Value min_size = compression_obj.Get("minSize");
+            double min_size_value = min_size.IsNumber() ? min_size.As<Napi::Number>().DoubleValue() : 0;
+            if (!codec.IsString() || !(min_size.IsUndefined() || min_size.IsNumber()) ||
+                    !(min_size_value >= 0 && min_size_value <= MAX_SAFE_INTEGER) ||
+                    std::floor(min_size_value) != min_size_value){
+                Napi::Error e = Napi::Error::New(env, "compression requires codec string and optional minSize non-negative integer");
+                e.Set("status", Napi::Number::New(env, int(pmem::kv::status::INVALID_ARGUMENT)));
+                e.ThrowAsJavaScriptException();
+                return;
+            }
+            auto status = this->_compression.configure(codec.As<Napi::String>().Utf8Value(),
+                static_cast<std::size_t>(min_size_value));
+            if (status != pmem::kv::status::OK){
+                Napi::Error e = Napi::Error::New(env, "unsupported compression codec");
+                e.Set("status", Napi::Number::New(env, int(status)));
+                e.ThrowAsJavaScriptException();
+                return;
+            }
+        }
+        else if (value.IsString()){
             auto status = cfg.put_string(key.As<Napi::String>().Utf8Value(), value.As<Napi::String>().Utf8Value());
 	        if (status != pmem::kv::status::OK){
                 Napi::Error e = Napi::Error::New(env, pmem::kv::errormsg());
@@ -180,6 +327,7 @@ Napi::Value db::stop(const Napi::CallbackInfo& info) {
 Napi::Value db::get_keys(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     Napi::Function cb = info[0].As<Napi::Function>();
+    record_copier copier(env);
     pmem::kv::status status;
     if (_key_type == KEY_TYPE_STRING){
         status = this->_db.get_all([&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
@@ -189,7 +337,7 @@ Napi::Value db::get_keys(const Napi::CallbackInfo& info) {
     }
     else {
         status = this->_db.get_all([&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
-            cb.Call(env.Global(), {create_napi_buffer(env, key)});
+            cb.Call(env.Global(), {copier.copy(key)});
             return 0;
         });
     }
@@ -207,6 +355,7 @@ Napi::Value db::get_keys_above(const Napi::CallbackInfo& info) {
     std::string key_str;
     GET_STRING_VIEW(env, info[0], key, key_str);
     Napi::Function cb = info[1].As<Napi::Function>();
+    record_copier copier(env);
     pmem::kv::status status;
     if (_key_type == KEY_TYPE_STRING){
         status = this->_db.get_above(key, [&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
@@ -216,7 +365,7 @@ Napi::Value db::get_keys_above(const Napi::CallbackInfo& info) {
     }
     else {
         status = this->_db.get_above(key, [&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
-            cb.Call(env.Global(), {create_napi_buffer(env, key)});
+            cb.Call(env.Global(), {copier.copy(key)});
             return 0;
         });
     }
@@ -234,6 +383,7 @@ Napi::Value db::get_keys_below(const Napi::CallbackInfo& info) {
     std::string key_str;
     GET_STRING_VIEW(env, info[0], key, key_str);
     Napi::Function cb = info[1].As<Napi::Function>();
+    record_copier copier(env);
     pmem::kv::status status;
     if (_key_type == KEY_TYPE_STRING){
         status = this->_db.get_below(key, [&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
@@ -243,7 +393,7 @@ Napi::Value db::get_keys_below(const Napi::CallbackInfo& info) {
     }
     else {
         status = this->_db.get_below(key, [&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
-            cb.Call(env.Global(), {create_napi_buffer(env, key)});
+            cb.Call(env.Global(), {copier.copy(key)});
             return 0;
         });
     }
@@ -264,6 +414,7 @@ Napi::Value db::get_keys_between(const Napi::CallbackInfo& info) {
     std::string key2_str;
     GET_STRING_VIEW(env, info[1], key2, key2_str);
     Napi::Function cb = info[2].As<Napi::Function>();
+    record_copier copier(env);
     pmem::kv::status status;
     if (_key_type == KEY_TYPE_STRING){
         status = this->_db.get_between(key1, key2, [&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
@@ -273,7 +424,7 @@ Napi::Value db::get_keys_between(const Napi::CallbackInfo& info) {
     }
     else {
         status = this->_db.get_between(key1, key2, [&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
-            cb.Call(env.Global(), {create_napi_buffer(env, key)});
+            cb.Call(env.Global(), {copier.copy(key)});
             return 0;
         });
     }
@@ -352,19 +503,26 @@ Napi::Value db::count_between(const Napi::CallbackInfo& info) {
 Napi::Value db::get_all(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     Napi::Function cb = info[0].As<Napi::Function>();
+    record_copier copier(env);
+    DecodeStatus decoded = DECODE_OK;
     pmem::kv::status status;
     if (_key_type == KEY_TYPE_STRING){
         status = this->_db.get_all([&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
+            std::string value_str;
+            DECODE_VALUE(value, value_str, decoded);
             cb.Call(env.Global(), {create_napi_string(env, key), create_napi_string(env, value)});
             return 0;
         });
     }
     else {
         status = this->_db.get_all([&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
-            cb.Call(env.Global(), {create_napi_buffer(env, key), create_napi_string(env, value)});
+            std::string value_str;
+            DECODE_VALUE(value, value_str, decoded);
+            cb.Call(env.Global(), {copier.copy(key), create_napi_string(env, value)});
             return 0;
         });
     }
+    THROW_IF_NOT_DECODED(env, decoded);
     if (status != pmem::kv::status::OK){
         Napi::Error e = Napi::Error::New(env, pmem::kv::errormsg());
         e.Set("status", Napi::Number::New(env, int(status)));
@@ -376,19 +534,26 @@ Napi::Value db::get_all(const Napi::CallbackInfo& info) {
 Napi::Value db::get_all_as_buffer(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     Napi::Function cb = info[0].As<Napi::Function>();
+    record_copier copier(env);
+    DecodeStatus decoded = DECODE_OK;
     pmem::kv::status status;
     if (_key_type == KEY_TYPE_STRING){
         status = this->_db.get_all([&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
-            cb.Call(env.Global(), {create_napi_string(env, key), create_napi_buffer(env, value)});
+            std::string value_str;
+            DECODE_VALUE(value, value_str, decoded);
+            cb.Call(env.Global(), {create_napi_string(env, key), copier.copy(value)});
             return 0;
         });
     }
     else {
         status = this->_db.get_all([&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
-            cb.Call(env.Global(), {create_napi_buffer(env, key), create_napi_buffer(env, value)});
+            std::string value_str;
+            DECODE_VALUE(value, value_str, decoded);
+            cb.Call(env.Global(), {copier.copy(key), copier.copy(value)});
             return 0;
         });
     }
+    THROW_IF_NOT_DECODED(env, decoded);
     if (status != pmem::kv::status::OK){
         Napi::Error e = Napi::Error::New(env, pmem::kv::errormsg());
         e.Set("status", Napi::Number::New(env, int(status)));
@@ -403,19 +568,26 @@ Napi::Value db::get_above(const Napi::CallbackInfo& info) {
     std::string key_str;
     GET_STRING_VIEW(env, info[0], key, key_str);
     Napi::Function cb = info[1].As<Napi::Function>();
+    record_copier copier(env);
+    DecodeStatus decoded = DECODE_OK;
     pmem::kv::status status;
     if (_key_type == KEY_TYPE_STRING){
         status = this->_db.get_above(key, [&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
+            std::string value_str;
+            DECODE_VALUE(value, value_str, decoded);
             cb.Call(env.Global(), {create_napi_string(env, key), create_napi_string(env, value)});
             return 0;
         });
     }
     else {
         status = this->_db.get_above(key, [&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
-            cb.Call(env.Global(), {create_napi_buffer(env, key), create_napi_string(env, value)});
+            std::string value_str;
+            DECODE_VALUE(value, value_str, decoded);
+            cb.Call(env.Global(), {copier.copy(key), create_napi_string(env, value)});
             return 0;
         });
     }
+    THROW_IF_NOT_DECODED(env, decoded);
     if (status != pmem::kv::status::OK){
         Napi::Error e = Napi::Error::New(env, pmem::kv::errormsg());
         e.Set("status", Napi::Number::New(env, int(status)));
@@ -430,19 +602,26 @@ Napi::Value db::get_above_as_buffer(const Napi::CallbackInfo& info) {
     std::string key_str;
     GET_STRING_VIEW(env, info[0], key, key_str);
     Napi::Function cb = info[1].As<Napi::Function>();
+    record_copier copier(env);
+    DecodeStatus decoded = DECODE_OK;
     pmem::kv::status status;
     if (_key_type == KEY_TYPE_STRING){
         status = this->_db.get_above(key, [&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
-            cb.Call(env.Global(), {create_napi_string(env, key), create_napi_buffer(env, value)});
+            std::string value_str;
+            DECODE_VALUE(value, value_str, decoded);
+            cb.Call(env.Global(), {create_napi_string(env, key), copier.copy(value)});
             return 0;
         });
     }
     else {
         status = this->_db.get_above(key, [&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
-            cb.Call(env.Global(), {create_napi_buffer(env, key), create_napi_buffer(env, value)});
+            std::string value_str;
+            DECODE_VALUE(value, value_str, decoded);
+            cb.Call(env.Global(), {copier.copy(key), copier.copy(value)});
             return 0;
         });
     }
+    THROW_IF_NOT_DECODED(env, decoded);
     if (status != pmem::kv::status::OK){
         Napi::Error e = Napi::Error::New(env, pmem::kv::errormsg());
         e.Set("status", Napi::Number::New(env, int(status)));
@@ -457,19 +636,26 @@ Napi::Value db::get_below(const Napi::CallbackInfo& info) {
     std::string key_str;
     GET_STRING_VIEW(env, info[0], key, key_str);
     Napi::Function cb = info[1].As<Napi::Function>();
+    record_copier copier(env);
+    DecodeStatus decoded = DECODE_OK;
     pmem::kv::status status;
     if (_key_type == KEY_TYPE_STRING){
         status = this->_db.get_below(key, [&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
+            std::string value_str;
+            DECODE_VALUE(value, value_str, decoded);
             cb.Call(env.Global(), {create_napi_string(env, key), create_napi_string(env, value)});
             return 0;
         });
     }
     else {
         status = this->_db.get_below(key, [&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
-            cb.Call(env.Global(), {create_napi_buffer(env, key), create_napi_string(env, value)});
+            std::string value_str;
+            DECODE_VALUE(value, value_str, decoded);
+            cb.Call(env.Global(), {copier.copy(key), create_napi_string(env, value)});
             return 0;
         });
     }
+    THROW_IF_NOT_DECODED(env, decoded);
     if (status != pmem::kv::status::OK){
         Napi::Error e = Napi::Error::New(env, pmem::kv::errormsg());
         e.Set("status", Napi::Number::New(env, int(status)));
@@ -484,19 +670,26 @@ Napi::Value db::get_below_as_buffer(const Napi::CallbackInfo& info) {
     std::string key_str;
     GET_STRING_VIEW(env, info[0], key, key_str);
     Napi::Function cb = info[1].As<Napi::Function>();
+    record_copier copier(env);
+    DecodeStatus decoded = DECODE_OK;
     pmem::kv::status status;
     if (_key_type == KEY_TYPE_STRING){
         status = this->_db.get_below(key, [&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
-            cb.Call(env.Global(), {create_napi_string(env, key), create_napi_buffer(env, value)});
+            std::string value_str;
+            DECODE_VALUE(value, value_str, decoded);
+            cb.Call(env.Global(), {create_napi_string(env, key), copier.copy(value)});
             return 0;
         });
     }
     else {
         status = this->_db.get_below(key, [&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
-            cb.Call(env.Global(), {create_napi_buffer(env, key), create_napi_buffer(env, value)});
+            std::string value_str;
+            DECODE_VALUE(value, value_str, decoded);
+            cb.Call(env.Global(), {copier.copy(key), copier.copy(value)});
             return 0;
         });
     }
+    THROW_IF_NOT_DECODED(env, decoded);
     if (status != pmem::kv::status::OK){
         Napi::Error e = Napi::Error::New(env, pmem::kv::errormsg());
         e.Set("status", Napi::Number::New(env, int(status)));
@@ -514,19 +707,26 @@ Napi::Value db::get_between(const Napi::CallbackInfo& info) {
     std::string key2_str;
     GET_STRING_VIEW(env, info[1], key2, key2_str);
     Napi::Function cb = info[2].As<Napi::Function>();
+    record_copier copier(env);
+    DecodeStatus decoded = DECODE_OK;
     pmem::kv::status status;
     if (_key_type == KEY_TYPE_STRING){
         status = this->_db.get_between(key1, key2, [&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
+            std::string value_str;
+            DECODE_VALUE(value, value_str, decoded);
             cb.Call(env.Global(), {create_napi_string(env, key), create_napi_string(env, value)});
             return 0;
         });
     }
     else {
         status = this->_db.get_between(key1, key2, [&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
-            cb.Call(env.Global(), {create_napi_buffer(env, key), create_napi_string(env, value)});
+            std::string value_str;
+            DECODE_VALUE(value, value_str, decoded);
+            cb.Call(env.Global(), {copier.copy(key), create_napi_string(env, value)});
             return 0;
         });
     }
+    THROW_IF_NOT_DECODED(env, decoded);
     if (status != pmem::kv::status::OK){
         Napi::Error e = Napi::Error::New(env, pmem::kv::errormsg());
         e.Set("status", Napi::Number::New(env, int(status)));
@@ -544,19 +744,26 @@ Napi::Value db::get_between_as_buffer(const Napi::CallbackInfo& info) {
     std::string key2_str;
     GET_STRING_VIEW(env, info[1], key2, key2_str);
     Napi::Function cb = info[2].As<Napi::Function>();
+    record_copier copier(env);
+    DecodeStatus decoded = DECODE_OK;
     pmem::kv::status status;
     if (_key_type == KEY_TYPE_STRING){
         status = this->_db.get_between(key1, key2, [&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
-            cb.Call(env.Global(), {create_napi_string(env, key), create_napi_buffer(env, value)});
+            std::string value_str;
+            DECODE_VALUE(value, value_str, decoded);
+            cb.Call(env.Global(), {create_napi_string(env, key), copier.copy(value)});
             return 0;
         });
     }
     else {
         status = this->_db.get_between(key1, key2, [&](pmem::kv::string_view key, pmem::kv::string_view value) -> int {
-            cb.Call(env.Global(), {create_napi_buffer(env, key), create_napi_buffer(env, value)});
+            std::string value_str;
+            DECODE_VALUE(value, value_str, decoded);
+            cb.Call(env.Global(), {copier.copy(key), copier.copy(value)});
             return 0;
         });
     }
+    THROW_IF_NOT_DECODED(env, decoded);
     if (status != pmem::kv::status::OK){
         Napi::Error e = Napi::Error::New(env, pmem::kv::errormsg());
         e.Set("status", Napi::Number::New(env, int(status)));
@@ -585,10 +792,14 @@ Napi::Value db::get(const Napi::CallbackInfo& info) {
     std::string key_str;
     GET_STRING_VIEW(env, info[0], key, key_str);
     Napi::Value result;
+    DecodeStatus decoded = DECODE_OK;
     pmem::kv::status status = this->_db.get(key, [&](pmem::kv::string_view value) -> int {
+        std::string value_str;
+        DECODE_VALUE(value, value_str, decoded);
         result = create_napi_string(env, value);
         return 0;
     });
+    THROW_IF_NOT_DECODED(env, decoded);
     if (status == pmem::kv::status::OK){
         return result;
     }
@@ -608,10 +819,14 @@ Napi::Value db::get_as_buffer(const Napi::CallbackInfo& info) {
     std::string key_str;
     GET_STRING_VIEW(env, info[0], key, key_str);
     Napi::Function cb = info[1].As<Napi::Function>();
+    DecodeStatus decoded = DECODE_OK;
     pmem::kv::status status = this->_db.get(key, [&](pmem::kv::string_view value) -> int {
-        cb.Call(env.Global(), {create_napi_buffer(env, value)});
+        std::string value_str;
+        DECODE_VALUE(value, value_str, decoded);
+        cb.Call(env.Global(), {Napi::Buffer<char>::Copy(env, value.data(), value.size())});
         return 0;
     });
+    THROW_IF_NOT_DECODED(env, decoded);
     if (status != pmem::kv::status::OK && status != pmem::kv::status::NOT_FOUND){
         Napi::Error e = Napi::Error::New(env, pmem::kv::errormsg());
         e.Set("status", Napi::Number::New(env, int(status)));
@@ -620,6 +835,69 @@ Napi::Value db::get_as_buffer(const Napi::CallbackInfo& info) {
     return env.Undefined();
 }
 
+Napi::Value db::with_view(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    pmem::kv::string_view key;
+    std::string key_str;
+    GET_STRING_VIEW(env, info[0], key, key_str);
+    Napi::Function cb = info[1].As<Napi::Function>();
+    Napi::Value result = env.Undefined();
+    DecodeStatus decoded = DECODE_OK;
+    pmem::kv::status status = this->_db.get(key, [&](pmem::kv::string_view value) -> int {
+        std::string value_str;
+        DECODE_VALUE(value, value_str, decoded);
+        if (value.data() != value_str.data()){
+            value_str.assign(value.data(), value.size());
+        }
+        read_lease lease(env);
+        result = cb.Call(env.Global(), {lease.view(value_str)});
+        return 0;
+    });
+    THROW_IF_NOT_DECODED(env, decoded);
+    if (status != pmem::kv::status::OK && status != pmem::kv::status::NOT_FOUND){
+        Napi::Error e = Napi::Error::New(env, pmem::kv::errormsg());
+        e.Set("status", Napi::Number::New(env, int(status)));
+        e.ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    return result;
+}
+
+/*
+ * Copies bytes [start, end) of the value into a new Buffer, so that only
+ * the requested slice, not the whole value, reaches the V8 heap.
+ * Bounds are clamped to the value's size.
+ */
+Napi::Value db::get_range(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    pmem::kv::string_view key;
+    std::string key_str;
+    GET_STRING_VIEW(env, info[0], key, key_str);
+    std::size_t start = std::max<int64_t>(info[1].As<Napi::Number>().Int64Value(), 0);
+    std::size_t end = std::max<int64_t>(info[2].As<Napi::Number>().Int64Value(), 0);
+    Napi::Value result;
+    DecodeStatus decoded = DECODE_OK;
+    pmem::kv::status status = this->_db.get(key, [&](pmem::kv::string_view value) -> int {
+        std::string value_str;
+        decoded = this->_compression.decode_range(value, start, end, value_str, value);
+        if (decoded != DECODE_OK){
+            return 1;
+        }
+        result = Napi::Buffer<char>::Copy(env, value.data(), value.size());
+        return 0;
+    });
+    THROW_IF_NOT_DECODED(env, decoded);
+    if (status == pmem::kv::status::OK){
+        return result;
+    }
+    else if (status != pmem::kv::status::NOT_FOUND) {
+        Napi::Error e = Napi::Error::New(env, pmem::kv::errormsg());
+        e.Set("status", Napi::Number::New(env, int(status)));
+        e.ThrowAsJavaScriptException();
+    }
+    return env.Undefined();
+}
+
 Napi::Value db::put(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     pmem::kv::string_view key;
@@ -628,12 +906,43 @@ Napi::Value db::put(const Napi::CallbackInfo& info) {
     pmem::kv::string_view value;
     std::string value_str;
     GET_STRING_VIEW(env, info[1], value, value_str);
-    pmem::kv::status status = this->_db.put(key, value);
+    std::string stored_str;
+    pmem::kv::string_view stored = this->_compression.encode(value, stored_str);
+    pmem::kv::status status = this->_db.put(key, stored);
+    if (status != pmem::kv::status::OK) {
+        Napi::Error e = Napi::Error::New(env, pmem::kv::errormsg());
+        e.Set("status", Napi::Number::New(env, int(status)));
+        e.ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    this->_compression.account(value.size(), stored.size());
+    this->_changes.record(key, false);
+    return env.Undefined();
+}
+
+Napi::Value db::put_staged(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    pmem::kv::string_view key;
+    std::string key_str;
+    GET_STRING_VIEW(env, info[0], key, key_str);
+    if (!info[1].IsObject() || !info[1].As<Napi::Object>().InstanceOf(value_writer::get_constructor())){
+        Napi::Error e = Napi::Error::New(env, "A value_writer is expected");
+        e.Set("status", Napi::Number::New(env, int(pmem::kv::status::INVALID_ARGUMENT)));
+        e.ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    value_writer* writer = value_writer::Unwrap(info[1].As<Napi::Object>());
+    std::string stored_str;
+    pmem::kv::string_view stored = this->_compression.encode(writer->view(), stored_str);
+    pmem::kv::status status = this->_db.put(key, stored);
     if (status != pmem::kv::status::OK) {
         Napi::Error e = Napi::Error::New(env, pmem::kv::errormsg());
         e.Set("status", Napi::Number::New(env, int(status)));
         e.ThrowAsJavaScriptException();
+        return env.Undefined();
     }
+    this->_compression.account(writer->view().size(), stored.size());
+    this->_changes.record(key, false);
     return env.Undefined();
 }
 
@@ -648,5 +957,86 @@ Napi::Value db::remove(const Napi::CallbackInfo& info) {
         e.Set("status", Napi::Number::New(env, int(status)));
         e.ThrowAsJavaScriptException();
     }
+    if (status == pmem::kv::status::OK){
+        this->_changes.record(key, true);
+    }
     return Napi::Boolean::New(env, (status == pmem::kv::status::OK));
 }
+
+Napi::Value db::compression_stats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Object stats = Napi::Object::New(env);
+    std::size_t raw_bytes = this->_compression.raw_bytes();
+    std::size_t stored_bytes = this->_compression.stored_bytes();
+    stats.Set("codec", this->_compression.codec_name());
+    stats.Set("raw_bytes", Napi::Number::New(env, raw_bytes));
+    stats.Set("stored_bytes", Napi::Number::New(env, stored_bytes));
+    stats.Set("ratio", Napi::Number::New(env, stored_bytes ? double(raw_bytes) / stored_bytes : 1.0));
+    return stats;
+}
+
+Napi::Value db::subscribe(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (!info[0].IsObject()){
+        Napi::Error e = Napi::Error::New(env, "filter should be an object");
+        e.Set("status", Napi::Number::New(env, int(pmem::kv::status::INVALID_ARGUMENT)));
+        e.ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    Napi::Object filter = info[0].As<Napi::Object>();
+    Napi::Value prefix = filter.Get("prefix");
+    Napi::Value start = filter.Get("start");
+    Napi::Value end = filter.Get("end");
+    if (!prefix.IsUndefined() && !(start.IsUndefined() && end.IsUndefined())){
+        Napi::Error e = Napi::Error::New(env, "filter should have either prefix or start/end");
+        e.Set("status", Napi::Number::New(env, int(pmem::kv::status::INVALID_ARGUMENT)));
+        e.ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    pmem::kv::string_view lower;
+    std::string lower_str;
+    pmem::kv::string_view upper;
+    std::string upper_str;
+    uint32_t id;
+    if (!prefix.IsUndefined()){
+        GET_STRING_VIEW(env, prefix, lower, lower_str);
+        id = this->_changes.subscribe(CHANGE_FILTER_PREFIX, lower, upper, false);
+    }
+    else {
+        if (!start.IsUndefined()){
+            GET_STRING_VIEW(env, start, lower, lower_str);
+        }
+        if (!end.IsUndefined()){
+            GET_STRING_VIEW(env, end, upper, upper_str);
+        }
+        id = this->_changes.subscribe(CHANGE_FILTER_RANGE, lower, upper, !end.IsUndefined());
+    }
+    return Napi::Number::New(env, id);
+}
+
+Napi::Value db::unsubscribe(const Napi::CallbackInfo& info) {
+    this->_changes.unsubscribe(info[0].As<Napi::Number>().Uint32Value());
+    return info.Env().Undefined();
+}
+
+Napi::Value db::take_changes(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::map<std::string, bool> changes;
+    if (!this->_changes.take(info[0].As<Napi::Number>().Uint32Value(), changes)){
+        return env.Undefined();
+    }
+    Napi::Array batch = Napi::Array::New(env, changes.size());
+    uint32_t i = 0;
+    for (const auto& change : changes){
+        Napi::Object entry = Napi::Object::New(env);
+        if (_key_type == KEY_TYPE_STRING){
+            entry.Set("key", create_napi_string(env, change.first));
+        }
+        else {
+            entry.Set("key", Napi::Buffer<char>::Copy(env, change.first.data(), change.first.size()));
+        }
+        entry.Set("type", change.second ? "remove" : "put");
+        batch.Set(i++, entry);
+    }
+    return batch;
+}
@@ -36,6 +36,8 @@
 #include <iostream>
 #include <libpmemkv.hpp>
 #include <napi.h>
+#include "change_feed.h"
+#include "compression.h"
 
 enum KeyType {KEY_TYPE_STRING, KEY_TYPE_BUFFER};
 
@@ -67,11 +69,20 @@ class db : public Napi::ObjectWrap<db> {
     Napi::Value exists(const Napi::CallbackInfo& info);
     Napi::Value get(const Napi::CallbackInfo& info);
     Napi::Value get_as_buffer(const Napi::CallbackInfo& info);
+    Napi::Value with_view(const Napi::CallbackInfo& info);
+    Napi::Value get_range(const Napi::CallbackInfo& info);
     Napi::Value put(const Napi::CallbackInfo& info);
+    Napi::Value put_staged(const Napi::CallbackInfo& info);
     Napi::Value remove(const Napi::CallbackInfo& info);
+    Napi::Value compression_stats(const Napi::CallbackInfo& info);
+    Napi::Value subscribe(const Napi::CallbackInfo& info);
+    Napi::Value unsubscribe(const Napi::CallbackInfo& info);
+    Napi::Value take_changes(const Napi::CallbackInfo& info);
 
     pmem::kv::db _db;
     KeyType _key_type;
+    compression _compression;
+    change_feed _changes;
 };
 
 #endif
@@ -42,22 +42,19 @@
  */
 
 const pmemkv = require('bindings')('pmemkv');
+const stream = require('stream');
 
-const immutable_buffer_proxy_handler = {
-	set(target, prop, value){
-		if (isNaN(prop)) {
-			target[prop] = value;
-		}
-	},
-	get(target, prop){
-		if (typeof(target[prop]) == 'function') return target[prop].bind(target);
-		return target[prop];
-	}
-};
+/** Default size of a single chunk moved by value streams. */
+const VALUE_STREAM_CHUNK_SIZE = 64 * 1024;
+
+/** Default time in milliseconds for which subscriptions coalesce changes. */
+const CHANGE_FLUSH_INTERVAL = 100;
 
 /** @class Main Node.js pmemkv class, it provides functions to operate on data in database.
  *		If an error/exception is thrown from a method it will contain *status* variable.
  *		Possible statuses are enumerated in constants.status.
+ *		Buffers returned by get_as_buffer and scans are copies of the stored data,
+ *		so modifying them does not affect the database.
 */
 class db {
 	/**
@@ -67,6 +64,10 @@ class db {
 	 * @throws {Error} on any failure.
 	 * @param {string} engine Name of the engine to work with.
 	 * @param {object} config JSON like config with parameters specified for the engine.
+	 *		It may also contain *compression* object, e.g. {codec: 'zlib', minSize: 256},
+	 *		to store values not shorter than *minSize* bytes compressed. Only 'zlib' codec
+	 *		is currently supported. A database created with compression enabled
+	 *		should NOT be reopened later without it.
 	 * @param {string} key_type Type of the key. Should be either "String" or "Buffer".
 	 * 		When a database is created with key of certain type it should NOT be reopened later using different key type.
 	 */
@@ -74,18 +75,35 @@ class db {
 		this._stopped = false;
 		this._db = new pmemkv.db(engine, config, key_type);
 		this._key_type = key_type;
+		this._subscriptions = new Map();
 		Object.defineProperty(this, '_db', {configurable: false, writable: false});
 		Object.defineProperty(this, '_key_type', {configurable: false, writable: false});
+		Object.defineProperty(this, '_subscriptions', {configurable: false, writable: false});
 	}
 
 	/**
 	 * Stops the database.
+	 * Pending changes are delivered to subscribers before it stops.
 	 */
 	stop() {
 		if (!this._stopped) {
 			this._stopped = true;
 			Object.defineProperty(this, '_stopped', {configurable: false, writable: false});
-			this._db.stop();
+			const subscriptions = Array.from(this._subscriptions);
+			this._subscriptions.clear();
+			for (const [, subscription] of subscriptions) {
+				clearTimeout(subscription.timer);
+			}
+			try {
+				for (const [, subscription] of subscriptions) {
+					subscription.flush();
+				}
+			} finally {
+				for (const [id] of subscriptions) {
+					this._db.unsubscribe(id);
+				}
+				this._db.stop();
+			}
 		}
 	}
 
@@ -107,6 +125,19 @@ class db {
 		return this._key_type;
 	}
 
+	/**
+	 * Returns compression statistics of write traffic through this db instance
+	 *	since it was opened. Every successful put is counted, including ones
+	 *	overwriting existing records, so it is not the ratio of data currently
+	 *	stored in the database.
+	 *
+	 * @return {object} *codec* name, *raw_bytes* and *stored_bytes* totals
+	 *	and their *ratio* (raw to stored).
+	 */
+	get compression_stats() {
+		return this._db.compression_stats();
+	}
+
 	/**
 	 * Executes function for every record stored in db.Callback is called
 	 *	only with the key of each record.
@@ -117,14 +148,7 @@ class db {
 	 *		Type of the key is consistent with _key_type.
 	 */
 	get_keys(callback) {
-		if (this._key_type == 'String'){
-			this._db.get_keys(callback);
-		}
-		else {
-			this._db.get_keys((k) => {
-				callback(new Proxy(k, immutable_buffer_proxy_handler));
-			})
-		}
+		this._db.get_keys(callback);
 	}
 
 	/**
@@ -138,14 +162,7 @@ class db {
 	 *		Type of the key is consistent with _key_type.
 	 */
 	get_keys_above(key, callback) {
-		if (this._key_type == 'String'){
-			this._db.get_keys_above(key, callback);
-		}
-		else {
-			this._db.get_keys_above(key, (k) => {
-				callback(new Proxy(k, immutable_buffer_proxy_handler));
-			})
-		}
+		this._db.get_keys_above(key, callback);
 	}
 
 	/**
@@ -159,14 +176,7 @@ class db {
 	 *		Type of the key is consistent with _key_type.
 	 */
 	get_keys_below(key, callback) {
-		if (this._key_type == 'String'){
-			this._db.get_keys_below(key, callback);
-		}
-		else {
-			this._db.get_keys_below(key, (k) => {
-				callback(new Proxy(k, immutable_buffer_proxy_handler));
-			})
-		}
+		this._db.get_keys_below(key, callback);
 	}
 
 	/**
@@ -182,14 +192,7 @@ class db {
 	 *		Type of the key is consistent with _key_type.
 	 */
 	get_keys_between(key1, key2, callback) {
-		if (this._key_type == 'String'){
-			this._db.get_keys_between(key1, key2, callback);
-		}
-		else {
-			this._db.get_keys_between(key1, key2, (k) => {
-				callback(new Proxy(k, immutable_buffer_proxy_handler));
-			})
-		}
+		this._db.get_keys_between(key1, key2, callback);
 	}
 
 	/**
@@ -254,14 +257,7 @@ class db {
 	 *		Type of the value is String.
 	 */
 	get_all(callback) {
-		if (this._key_type == 'String'){
-			this._db.get_all(callback);
-		}
-		else {
-			this._db.get_all((k, v) => {
-				callback(new Proxy(k, immutable_buffer_proxy_handler), v);
-			});
-		}
+		this._db.get_all(callback);
 	}
 
 	/**
@@ -275,17 +271,7 @@ class db {
 	 *		Type of the value is Buffer.
 	 */
 	get_all_as_buffer(callback) {
-		if (this._key_type == 'String'){
-			this._db.get_all_as_buffer((k, v) => {
-				let proxy = new Proxy(v, immutable_buffer_proxy_handler);
-				callback(k, proxy);
-			});
-		}
-		else {
-			this._db.get_all_as_buffer((k, v) => {
-				callback(new Proxy(k, immutable_buffer_proxy_handler), new Proxy(v, immutable_buffer_proxy_handler));
-			});
-		}
+		this._db.get_all_as_buffer(callback);
 	}
 
 	/**
@@ -301,14 +287,7 @@ class db {
 	 *		Type of the value is String.
 	 */
 	get_above(key, callback) {
-		if (this._key_type == 'String'){
-			this._db.get_above(key, callback);
-		}
-		else {
-			this._db.get_above(key, (k, v) => {
-				callback(new Proxy(k, immutable_buffer_proxy_handler), v);
-			});
-		}
+		this._db.get_above(key, callback);
 	}
 
 	/**
@@ -324,16 +303,7 @@ class db {
 	 *		Type of the value is Buffer.
 	 */
 	get_above_as_buffer(key, callback) {
-		if (this._key_type == 'String'){
-			this._db.get_above_as_buffer(key, (k, v) => {
-				callback(k, new Proxy(v, immutable_buffer_proxy_handler));
-			});
-		}
-		else {
-			this._db.get_above_as_buffer(key, (k, v) => {
-				callback(new Proxy(k, immutable_buffer_proxy_handler), new Proxy(v, immutable_buffer_proxy_handler));
-			});
-		}
+		this._db.get_above_as_buffer(key, callback);
 	}
 
 	/**
@@ -349,14 +319,7 @@ class db {
 	 *		Type of the value is String.
 	 */
 	get_below(key, callback) {
-		if (this._key_type == 'String'){
-			this._db.get_below(key, callback);
-		}
-		else {
-			this._db.get_below(key, (k, v) => {
-				callback(new Proxy(k, immutable_buffer_proxy_handler), v);
-			});
-		}
+		this._db.get_below(key, callback);
 	}
 
 	/**
@@ -372,16 +335,7 @@ class db {
 	 *		Type of the value is Buffer.
 	 */
 	get_below_as_buffer(key, callback) {
-		if (this._key_type == 'String'){
-			this._db.get_below_as_buffer(key, (k, v) => {
-				callback(k, new Proxy(v, immutable_buffer_proxy_handler));
-			});
-		}
-		else {
-			this._db.get_below_as_buffer(key, (k, v) => {
-				callback(new Proxy(k, immutable_buffer_proxy_handler), new Proxy(v, immutable_buffer_proxy_handler));
-			});
-		}
+		this._db.get_below_as_buffer(key, callback);
 	}
 
 	/**
@@ -398,14 +352,7 @@ class db {
 	 *		Type of the value is String.
 	 */
 	get_between(key1, key2, callback) {
-		if (this._key_type == 'String'){
-			this._db.get_between(key1, key2, callback);
-		}
-		else {
-			this._db.get_between(key1, key2, (k, v) => {
-				callback(new Proxy(k, immutable_buffer_proxy_handler), v);
-			});
-		}
+		this._db.get_between(key1, key2, callback);
 	}
 
 	/**
@@ -422,16 +369,7 @@ class db {
 	 *		Type of the value is Buffer.
 	 */
 	get_between_as_buffer(key1, key2, callback) {
-		if (this._key_type == 'String'){
-			this._db.get_between_as_buffer(key1, key2, (k, v) => {
-				callback(k, new Proxy(v, immutable_buffer_proxy_handler));
-			});
-		}
-		else {
-			this._db.get_between_as_buffer(key1, key2, (k, v) => {
-				callback(new Proxy(k, immutable_buffer_proxy_handler), new Proxy(v, immutable_buffer_proxy_handler));
-			});
-		}
+		this._db.get_between_as_buffer(key1, key2, callback);
 	}
 
 	/**
@@ -470,9 +408,24 @@ class db {
 	 *		Type of the value is Buffer.
 	 */
 	get_as_buffer(key, callback) {
-		this._db.get_as_buffer(key, (v) => {
-			callback(new Proxy(v, immutable_buffer_proxy_handler));
-		});
+		this._db.get_as_buffer(key, callback);
+	}
+
+	/**
+	 * Executes function with a view of the value of record with given *key*.
+	 * The view is a Buffer over a private native copy of the value, which is not
+	 *	moved to the V8 heap, so writing to it does not affect the database.
+	 *	It is detached when the function returns: the view, and any slice of it,
+	 *	is then empty, so data needed later has to be copied, e.g. with Buffer.from().
+	 *
+	 * @throws {Error} on any failure.
+	 * @param {string|Buffer} key - record's key to query for.
+	 * @param {Function} fn - function to be called with the value as Buffer.
+	 *		It is not called if record does not exist.
+	 * @return {*} value returned by *fn*, or undefined if record does not exist.
+	 */
+	withView(key, fn) {
+		return this._db.with_view(key, fn);
 	}
 
 	/**
@@ -484,6 +437,102 @@ class db {
 	 */
 	put(key, value) {
 		this._db.put(key, value);
+		this._notify();
+	}
+
+	/**
+	 * Creates a readable stream over the value of record with given *key*.
+	 * The value is read in chunks of at most *highWaterMark* bytes, each copied
+	 *	directly from pmem, so memory use does not depend on the value's size.
+	 * Every chunk is looked up separately; if the record is modified while
+	 *	streaming, later chunks come from the new value.
+	 * Compressed values are stored in independent blocks, and only the blocks
+	 *	overlapping each chunk are inflated.
+	 *
+	 * @param {string|Buffer} key - record's key to query for.
+	 * @param {object} options - optional *start* and *end* byte offsets
+	 *	(both inclusive, as in fs.createReadStream) and *highWaterMark*.
+	 * @return {stream.Readable} stream emitting Buffer chunks of the value.
+	 *	It emits an error with status NOT_FOUND if the record does not exist.
+	 */
+	createValueReadStream(key, options = {}) {
+		const db = this._db;
+		const end = (options.end === undefined) ? Number.MAX_SAFE_INTEGER : options.end + 1;
+		let pos = options.start || 0;
+		return new stream.Readable({
+			highWaterMark: options.highWaterMark || VALUE_STREAM_CHUNK_SIZE,
+			read(size) {
+				let chunk;
+				try {
+					chunk = db.get_range(key, pos, Math.min(pos + size, end));
+				} catch (e) {
+					this.destroy(e);
+					return;
+				}
+				if (chunk === undefined) {
+					const e = new Error('record not found');
+					e.status = pmemkv.constants.status.NOT_FOUND;
+					this.destroy(e);
+				} else if (chunk.length == 0) {
+					this.push(null);
+				} else {
+					pos += chunk.length;
+					this.push(chunk);
+				}
+			}
+		});
+	}
+
+	/**
+	 * Creates a writable stream storing a value of *size* bytes under given *key*.
+	 * Written chunks are staged in native memory, outside of the V8 heap, and
+	 *	the record is put into database once the stream is finished. The record
+	 *	is not modified if the stream is destroyed before finishing.
+	 * Unlike reading, writing is not constant-memory: the staging area grows up
+	 *	to the value's size. libpmemkv 1.0 cannot write a value partially, and
+	 *	splitting it into separate chunk records is not used, as they would be
+	 *	visible to scans and counts as ordinary keys and, without transactions
+	 *	spanning several puts, could be left half-written by a crash.
+	 *
+	 * @throws {Error} on any failure.
+	 * @param {string|Buffer} key - record's key; record will be put into database under its name.
+	 * @param {number} size - exact length of the value in bytes.
+	 * @return {stream.Writable} stream accepting Buffer or string chunks of the value.
+	 */
+	createValueWriteStream(key, size) {
+		const db = this._db;
+		const notify = () => this._notify();
+		const writer = new pmemkv.value_writer(size);
+		return new stream.Writable({
+			write(chunk, encoding, callback) {
+				try {
+					writer.append(chunk);
+				} catch (e) {
+					return callback(e);
+				}
+				callback();
+			},
+			final(callback) {
+				if (writer.length != size) {
+					const e = new Error(`value is ${writer.length} bytes long, ${size} declared`);
+					e.status = pmemkv.constants.status.INVALID_ARGUMENT;
+					return callback(e);
+				}
+				try {
+					db.put_staged(key, writer);
+				} catch (e) {
+					return callback(e);
+				} finally {
+					writer.clear();
+				}
+				notify();
+				callback();
+			},
+			destroy(err, callback) {
+				writer.clear();
+				callback(err);
+			}
+		});
 	}
 
 	/**
@@ -494,7 +543,75 @@ class db {
 	 * @return {boolean} True if pmemkv returned status OK, False if status NOT_FOUND.
 	 */
 	remove(key) {
-		return this._db.remove(key);
+		const removed = this._db.remove(key);
+		if (removed) {
+			this._notify();
+		}
+		return removed;
+	}
+
+	/**
+	 * Subscribes to changes of records made through this db instance.
+	 * Puts and removes of matching keys are logged natively and delivered
+	 *	in batches, at most once per *flushInterval*. Changes of the same key
+	 *	within a batch are coalesced into the last one.
+	 *
+	 * @throws {Error} on any failure, e.g. if the database is stopped or
+	 *	the filter is invalid (status INVALID_ARGUMENT).
+	 * @param {object} filter - either *prefix* of keys to watch, or *start*
+	 *	(inclusive) and *end* (exclusive) bounds of watched keys; both bounds
+	 *	are optional. It may also contain *flushInterval*, a non-negative
+	 *	number of milliseconds.
+	 * @param {Function} on_batch - function to be called with an array of changes.
+	 *		Each change has *key* (type consistent with _key_type) and *type*,
+	 *		which is either "put" or "remove". Changes are sorted by key.
+	 * @return {Function} function which cancels the subscription; changes
+	 *	which are not delivered yet are dropped.
+	 */
+	subscribe(filter, on_batch) {
+		if (this._stopped) {
+			const e = new Error('database is stopped');
+			e.status = pmemkv.constants.status.INVALID_ARGUMENT;
+			throw e;
+		}
+		const interval = (filter instanceof Object && filter.flushInterval !== undefined) ?
+			filter.flushInterval : CHANGE_FLUSH_INTERVAL;
+		if (typeof interval !== 'number' || !isFinite(interval) || interval < 0) {
+			const e = new Error('flushInterval should be a non-negative number');
+			e.status = pmemkv.constants.status.INVALID_ARGUMENT;
+			throw e;
+		}
+		const id = this._db.subscribe(filter);
+		const subscription = {
+			interval: interval,
+			timer: undefined,
+			flush: () => {
+				subscription.timer = undefined;
+				const batch = this._db.take_changes(id);
+				if (batch !== undefined && batch.length != 0) {
+					on_batch(batch);
+				}
+			}
+		};
+		this._subscriptions.set(id, subscription);
+		return () => {
+			if (this._subscriptions.delete(id)) {
+				clearTimeout(subscription.timer);
+				this._db.unsubscribe(id);
+			}
+		};
+	}
+
+	/**
+	 * Schedules delivery of changes logged for subscriptions.
+	 */
+	_notify() {
+		for (const subscription of this._subscriptions.values()) {
+			if (subscription.timer === undefined) {
+				subscription.timer = setTimeout(subscription.flush, subscription.interval);
+				subscription.timer.unref();
+			}
+		}
 	}
 }
 
@@ -32,9 +32,11 @@
 
 #include <napi.h>
 #include "database.h"
+#include "value_writer.h"
 
 Napi::Object initAll(Napi::Env env, Napi::Object exports) {
-    return db::init(env, exports);
+    db::init(env, exports);
+    return value_writer::init(env, exports);
 }
 
 NODE_API_MODULE(pmemkv, initAll)
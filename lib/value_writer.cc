@@ -0,0 +1,102 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "value_writer.h"
+#include <exception>
+
+Napi::FunctionReference value_writer::constructor;
+
+Napi::Object value_writer::init(Napi::Env env, Napi::Object exports) {
+    Napi::HandleScope scope(env);
+
+    Napi::Function func = DefineClass(env, "value_writer", {
+            InstanceMethod("append", &value_writer::append),
+            InstanceMethod("clear", &value_writer::clear),
+            InstanceAccessor("length", &value_writer::get_length, nullptr)
+    });
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+    exports.Set("value_writer", func);
+
+    return exports;
+}
+
+value_writer::value_writer(const Napi::CallbackInfo& info) : Napi::ObjectWrap<value_writer>(info), _data(), _size(0) {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+    if (info.Length() != 1 || !info[0].IsNumber() || info[0].As<Napi::Number>().Int64Value() < 0){
+        Napi::Error::New(env, "size must be a non-negative number").ThrowAsJavaScriptException();
+        return;
+    }
+    this->_size = info[0].As<Napi::Number>().Int64Value();
+}
+
+Napi::Function value_writer::get_constructor() {
+    return constructor.Value();
+}
+
+pmem::kv::string_view value_writer::view() const {
+    return pmem::kv::string_view(this->_data.data(), this->_data.size());
+}
+
+Napi::Value value_writer::append(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (!info[0].IsBuffer()){
+        Napi::Error::New(env, "A Buffer is expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    Napi::Buffer<char> chunk = info[0].As<Napi::Buffer<char>>();
+    if (chunk.Length() > this->_size - this->_data.size()){
+        Napi::Error e = Napi::Error::New(env, "value exceeds declared size");
+        e.Set("status", Napi::Number::New(env, int(pmem::kv::status::INVALID_ARGUMENT)));
+        e.ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    try {
+        this->_data.append(chunk.Data(), chunk.Length());
+    } catch (std::exception& ex) {
+        Napi::Error e = Napi::Error::New(env, ex.what());
+        e.Set("status", Napi::Number::New(env, int(pmem::kv::status::OUT_OF_MEMORY)));
+        e.ThrowAsJavaScriptException();
+    }
+    return env.Undefined();
+}
+
+Napi::Value value_writer::clear(const Napi::CallbackInfo& info) {
+    std::string().swap(this->_data);
+    this->_size = 0;
+    return info.Env().Undefined();
+}
+
+Napi::Value value_writer::get_length(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), this->_data.size());
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2019, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VALUE_WRITER_H
+#define VALUE_WRITER_H
+
+#include <string>
+#include <libpmemkv.hpp>
+#include <napi.h>
+
+/*
+ * Native staging area for values written in chunks (see db::put_staged).
+ * Chunks are copied here instead of being concatenated on the V8 heap,
+ * and the whole value is stored with a single put once complete. Memory
+ * grows with the data actually written; the declared size is only a limit.
+ */
+class value_writer : public Napi::ObjectWrap<value_writer> {
+  public:
+    static Napi::Object init(Napi::Env env, Napi::Object exports);
+    value_writer(const Napi::CallbackInfo& info);
+
+    static Napi::Function get_constructor();
+
+    pmem::kv::string_view view() const;
+
+  private:
+    static Napi::FunctionReference constructor;
+
+    Napi::Value append(const Napi::CallbackInfo& info);
+    Napi::Value clear(const Napi::CallbackInfo& info);
+    Napi::Value get_length(const Napi::CallbackInfo& info);
+
+    std::string _data;
+    std::size_t _size;
+};
+
+#endif
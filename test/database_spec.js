@@ -100,6 +100,136 @@ describe('db', () => {
         db.stop();
     });
 
+    it('keeps value buffer after callback', () => {
+        const db = new pmemkv.db(ENGINE, CONFIG);
+        db.put('key1', 'value1');
+        let kept = undefined;
+        db.get_as_buffer('key1', (v) => {
+            kept = v;
+            v[0] = 0x56;
+        });
+        expect(kept.toString()).to.equal('Value1');
+        expect(db.get('key1')).to.equal('value1');
+        db.stop();
+    });
+
+    it('uses value view', () => {
+        const db = new pmemkv.db(ENGINE, CONFIG);
+        db.put('key1', 'value1');
+        let kept = undefined;
+        let kept_slice = undefined;
+        const result = db.withView('key1', (v) => {
+            expect(Buffer.isBuffer(v)).to.be.true;
+            kept = v;
+            kept_slice = v.subarray(2);
+            const part = v.slice(2, 4).toString();
+            v.fill(0);
+            return part;
+        });
+        expect(result).to.equal('lu');
+        expect(db.get('key1')).to.equal('value1');
+        expect(kept.length).to.equal(0);
+        expect(kept_slice.length).to.equal(0);
+        expect(() => kept.readUInt8(0)).to.throw();
+        expect(db.withView('key2', (v) => 'nope')).not.to.exist;
+        db.stop();
+    });
+
+    it('throws exception on staged put of foreign object', () => {
+        const db = new pmemkv.db(ENGINE, CONFIG);
+        try {
+            db._db.put_staged('key1', {});
+            expect(true).to.be.false;
+        } catch (e) {
+            expect(e.status).to.equal(constants.status.INVALID_ARGUMENT);
+        }
+        expect(db.exists('key1')).to.be.false;
+        db.stop();
+    });
+
+    it('streams value in chunks', (done) => {
+        const db = new pmemkv.db(ENGINE, CONFIG);
+        db.put('key1', 'value1');
+        const chunks = [];
+        db.createValueReadStream('key1', {highWaterMark: 4})
+            .on('data', (c) => chunks.push(c.toString()))
+            .on('end', () => {
+                expect(chunks).to.deep.equal(['valu', 'e1']);
+                db.stop();
+                done();
+            });
+    });
+
+    it('streams value range', (done) => {
+        const db = new pmemkv.db(ENGINE, CONFIG);
+        db.put('key1', 'value1');
+        let x = '';
+        db.createValueReadStream('key1', {start: 1, end: 3})
+            .on('data', (c) => x += c)
+            .on('end', () => {
+                expect(x).to.equal('alu');
+                db.stop();
+                done();
+            });
+    });
+
+    it('streams missing key', (done) => {
+        const db = new pmemkv.db(ENGINE, CONFIG);
+        db.createValueReadStream('key1')
+            .on('error', (e) => {
+                expect(e.status).to.equal(constants.status.NOT_FOUND);
+                db.stop();
+                done();
+            })
+            .resume();
+    });
+
+    it('puts value from stream', (done) => {
+        const db = new pmemkv.db(ENGINE, CONFIG);
+        const ws = db.createValueWriteStream('key1', 12);
+        ws.write('value1');
+        ws.end(Buffer.from('value2'));
+        ws.on('finish', () => {
+            expect(db.get('key1')).to.equal('value1value2');
+            db.stop();
+            done();
+        });
+    });
+
+    it('streams compressed value', (done) => {
+        const config = Object.assign({"compression": {"codec": "zlib"}}, CONFIG);
+        const db = new pmemkv.db(ENGINE, config);
+        const val = 'value1'.repeat(30000);
+        db.put('key1', val);
+        let x = '';
+        db.createValueReadStream('key1', {"start": 60000, "highWaterMark": 10000})
+            .on('data', (c) => x += c)
+            .on('end', () => {
+                expect(x).to.equal(val.slice(60000));
+                const stored = db.compression_stats.stored_bytes;
+                const ws = db.createValueWriteStream('key2', val.length);
+                ws.end(val);
+                ws.on('finish', () => {
+                    expect(db.get('key2')).to.equal(val);
+                    expect(db.compression_stats.stored_bytes - stored).to.be.below(val.length / 3);
+                    db.stop();
+                    done();
+                });
+            });
+    });
+
+    it('does not put value from stream of wrong size', (done) => {
+        const db = new pmemkv.db(ENGINE, CONFIG);
+        const ws = db.createValueWriteStream('key1', 12);
+        ws.on('error', (e) => {
+            expect(e.status).to.equal(constants.status.INVALID_ARGUMENT);
+            expect(db.exists('key1')).to.be.false;
+            db.stop();
+            done();
+        });
+        ws.end('value1');
+    });
+
     it('puts basic value', () => {
         const db = new pmemkv.db(ENGINE, CONFIG);
         expect(db.exists('key1')).to.be.false;
@@ -288,6 +418,131 @@ describe('db', () => {
         expect(db).not.to.exist;
     });
 
+    it('throws exception on start when compression codec is unsupported', () => {
+        let db = undefined;
+        try {
+            let config = Object.assign({"compression": {"codec": "lz4"}}, CONFIG);
+            db = new pmemkv.db(ENGINE, config);
+            expect(true).to.be.false;
+        } catch (e) {
+            expect(e.status).to.equal(constants.status.NOT_SUPPORTED);
+        }
+        expect(db).not.to.exist;
+    });
+
+    it('throws exception on start when compression minSize is invalid', () => {
+        for (const min_size of [-1, 1.5, NaN, '16']) {
+            const config = Object.assign({"compression": {"codec": "zlib", "minSize": min_size}}, CONFIG);
+            let db = undefined;
+            try {
+                db = new pmemkv.db(ENGINE, config);
+                expect(true).to.be.false;
+            } catch (e) {
+                expect(e.status).to.equal(constants.status.INVALID_ARGUMENT);
+            }
+            expect(db).not.to.exist;
+        }
+    });
+
+    it('puts compressed value', () => {
+        const config = Object.assign({"compression": {"codec": "zlib", "minSize": 16}}, CONFIG);
+        const db = new pmemkv.db(ENGINE, config);
+        const val = '{"key": "value"}'.repeat(64);
+        db.put('key1', val);
+        db.put('key2', 'short');
+        expect(db.get('key1')).to.equal(val);
+        expect(db.get('key2')).to.equal('short');
+        db.get_as_buffer('key1', (v) => {
+            expect(v.toString()).to.equal(val);
+        });
+        let x = '';
+        db.get_all((k, v) => x += `${k},${v.length}|`);
+        expect(x).to.equal(`key1,${val.length}|key2,5|`);
+        const stats = db.compression_stats;
+        expect(stats.codec).to.equal('zlib');
+        expect(stats.raw_bytes).to.equal(val.length + 5);
+        expect(stats.ratio).to.be.above(3);
+        db.stop();
+    });
+
+    it('delivers coalesced changes to subscriber', (done) => {
+        const db = new pmemkv.db(ENGINE, CONFIG);
+        db.subscribe({"prefix": "key", "flushInterval": 10}, (batch) => {
+            expect(batch).to.deep.equal([
+                {"key": "key1", "type": "put"},
+                {"key": "key2", "type": "remove"}
+            ]);
+            db.stop();
+            done();
+        });
+        db.put('key1', 'value1');
+        db.put('key1', 'value2');
+        db.put('other', 'value3');
+        db.put('key2', 'value4');
+        db.remove('key2');
+        db.remove('key3');
+    });
+
+    it('delivers changes of key range to subscriber', () => {
+        const db = new pmemkv.db(ENGINE, CONFIG, 'Buffer');
+        const batches = [];
+        const unsubscribe = db.subscribe({"start": Buffer.from('B'), "end": Buffer.from('C')}, (batch) => {
+            batches.push(batch.map((c) => `${c.key},${c.type}`).join('|'));
+        });
+        db.put(Buffer.from('A'), '1');
+        db.put(Buffer.from('B'), '2');
+        db.put(Buffer.from('BB'), '3');
+        db.put(Buffer.from('C'), '4');
+        db.stop();
+        unsubscribe();
+        expect(batches).to.deep.equal(['B,put|BB,put']);
+    });
+
+    it('stops delivering changes after unsubscribe', (done) => {
+        const db = new pmemkv.db(ENGINE, CONFIG);
+        const unsubscribe = db.subscribe({"flushInterval": 1}, (batch) => {
+            expect(true).to.be.false;
+        });
+        db.put('key1', 'value1');
+        unsubscribe();
+        setTimeout(() => {
+            db.stop();
+            done();
+        }, 10);
+    });
+
+    it('stops database when subscriber throws', () => {
+        const db = new pmemkv.db(ENGINE, CONFIG);
+        db.subscribe({}, (batch) => {
+            throw new Error('subscriber failed');
+        });
+        db.put('key1', 'value1');
+        expect(() => db.stop()).to.throw('subscriber failed');
+        expect(db.stopped).to.be.true;
+        expect(db._subscriptions.size).to.equal(0);
+    });
+
+    it('throws exception on subscribe with invalid filter', () => {
+        const db = new pmemkv.db(ENGINE, CONFIG);
+        const filters = [
+            undefined,
+            {"prefix": "key", "start": "key1"},
+            {"prefix": "key", "flushInterval": -1},
+            {"prefix": "key", "flushInterval": "10"},
+            {"prefix": "key", "flushInterval": Infinity},
+        ];
+        for (const filter of filters) {
+            expect(() => db.subscribe(filter, () => {})).to.throw().with.property('status', constants.status.INVALID_ARGUMENT);
+        }
+        db.stop();
+    });
+
+    it('throws exception on subscribe after stop', () => {
+        const db = new pmemkv.db(ENGINE, CONFIG);
+        db.stop();
+        expect(() => db.subscribe({}, (batch) => {})).to.throw().with.property('status', constants.status.INVALID_ARGUMENT);
+    });
+
     it('uses get_keys_test', () => {
         const db = new pmemkv.db(ENGINE, CONFIG);
         db.put('1', 'one');
@@ -328,6 +583,40 @@ describe('db', () => {
         db.stop();
     });
 
+    it('keeps returned keys as Buffer after callback', () => {
+        const db = new pmemkv.db(ENGINE, CONFIG, 'Buffer');
+        db.put('1', 'one');
+        db.put('2', 'two');
+        db.put('记!', 'RR');
+        const keys = [];
+        db.get_keys((k) => keys.push(k));
+        keys[0][0] = 0x33;
+        expect(keys.map((k) => k.toString())).to.deep.equal(['3', '2', '记!']);
+        expect(Buffer.isBuffer(keys[1])).to.be.true;
+
+        x = '';
+        db.get_keys((k) => x += `<${k}>,`);
+        expect(x).to.equal('<1>,<2>,<记!>,');
+
+        db.stop();
+    });
+
+    it('returns empty key and value as Buffer', () => {
+        const db = new pmemkv.db(ENGINE, CONFIG, 'Buffer');
+        db.put('', '');
+        db.put('1', 'one');
+
+        let x = '';
+        db.get_keys((k) => x += `<${k}>,`);
+        expect(x).to.equal('<>,<1>,');
+
+        x = '';
+        db.get_all_as_buffer((k, v) => x += `<${k}>,<${v}>|`);
+        expect(x).to.equal('<>,<>|<1>,<one>|');
+
+        db.stop();
+    });
+
     it('uses get_keys_above test', () => {
         const db = new pmemkv.db(ENGINE, CONFIG);
         db.put('A', '1');